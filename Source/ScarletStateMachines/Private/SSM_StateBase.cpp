@@ -16,4 +16,12 @@ void USSM_StateBase::STATEMACHINE_SetStateMachine(USSM_StateMachine* InStateMach
     StateMachine = InStateMachine;
 
     STATEMACHINE_OnSetStateMachine();
+}
+
+// Called from the state machine, when it is being reset
+void USSM_StateBase::STATEMACHINE_ResetStateMachine()
+{
+    Locked = false;
+
+    STATEMACHINE_OnResetStateMachine();
 }
\ No newline at end of file
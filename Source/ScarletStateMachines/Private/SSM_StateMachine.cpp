@@ -2,6 +2,7 @@
 
 
 #include "SSM_StateMachine.h"
+#include "CoreGlobals.h"
 
 // Default constructor
 USSM_StateMachine::USSM_StateMachine() {}
@@ -10,7 +11,46 @@ USSM_StateMachine::USSM_StateMachine() {}
 // Call this when the state machine is created
 void USSM_StateMachine::InitStateMachine()
 {
+#if SSM_WITH_TRANSITION_HISTORY
+    if (!TransitionHistory && FStateTransitionHistory::GetDefaultCapacity() > 0)
+        EnableTransitionHistory(FStateTransitionHistory::GetDefaultCapacity());
+#endif
+
     OnInitStateMachine();
+
+    InitialBufferedState = BufferedNewState;
+    Initialized = true;
+}
+
+
+// Brings the state machine back to the state it was in right after the initialization
+void USSM_StateMachine::ResetStateMachine()
+{
+    if (ActiveState != 0 && IsValid(GetState(ActiveState)))
+        States[ActiveState]->ExitState();
+
+    ActiveState = 0;
+    BufferedNewState = InitialBufferedState;
+
+    // Bindings of the state machine and its states are a part of the initialization, so only external listeners are removed
+    for (UObject* Listener: OnStateChanged.GetAllObjects())
+    {
+        USSM_StateBase* ListenerState = Cast<USSM_StateBase>(Listener);
+
+        if (Listener != this && !(ListenerState && States.FindKey(ListenerState)))
+            OnStateChanged.RemoveAll(Listener);
+    }
+
+#if SSM_WITH_TRANSITION_HISTORY
+    if (TransitionHistory)
+        TransitionHistory->Reset();
+#endif
+
+    for (auto& State: States)
+        if (IsValid(State.Value))
+            State.Value->STATEMACHINE_ResetStateMachine();
+
+    OnResetStateMachine();
 }
 
 
@@ -31,12 +71,15 @@ void USSM_StateMachine::UpdateStateMachine(float DeltaTime)
     {
         if (!States[ActiveState]->IsLocked())
         {
-            for (auto& Transition: TransitionMap[ActiveState])
+            TArray<FStateTransition>& Transitions = TransitionMap[ActiveState];
+
+            for (int32 TransitionIndex = 0; TransitionIndex < Transitions.Num(); TransitionIndex++)
             {
+                FStateTransition& Transition = Transitions[TransitionIndex];
 
                 if (Transition.ConditionDelegate.IsBound() && Transition.ConditionDelegate.Execute())
                 {
-                    StateTransition(Transition.TargetState);
+                    StateTransition(Transition.TargetState, TransitionIndex);
                     TransitionHappened = true;
                     break;
                 }
@@ -52,10 +95,15 @@ void USSM_StateMachine::UpdateStateMachine(float DeltaTime)
 
 
 // Sets a new active state
-void USSM_StateMachine::StateTransition(uint8 InNewState)
+void USSM_StateMachine::StateTransition(uint8 InNewState, int32 InTransitionIndex)
 {
     uint8 PreviousState = ActiveState;
 
+#if SSM_WITH_TRANSITION_HISTORY
+    if (TransitionHistory || FStateTransitionRecorder::IsRecording())
+        RecordTransition(PreviousState, InNewState, InTransitionIndex);
+#endif
+
     if (ActiveState != 0)
         States[ActiveState]->ExitState();
 
@@ -65,6 +113,36 @@ void USSM_StateMachine::StateTransition(uint8 InNewState)
     OnStateChanged.Broadcast(PreviousState, InNewState);
 }
 
+#if SSM_WITH_TRANSITION_HISTORY
+// Writes the transition into the history and the transition recorder
+void USSM_StateMachine::RecordTransition(uint8 InPreviousState, uint8 InNewState, int32 InTransitionIndex)
+{
+    // Conditions are evaluated in order until one passes, so the evaluated ones are the bound transitions up to the fired one
+    // Counting them here keeps the update loop free of any bookkeeping
+    int32 EvaluatedConditions = 0;
+
+    if (const TArray<FStateTransition>* Transitions = TransitionMap.Find(InPreviousState))
+        for (int32 TransitionIndex = 0; TransitionIndex <= InTransitionIndex && TransitionIndex < Transitions->Num(); TransitionIndex++)
+            if ((*Transitions)[TransitionIndex].ConditionDelegate.IsBound())
+                EvaluatedConditions++;
+
+    FStateTransitionRecord Record;
+
+    Record.FrameNumber = (int64)GFrameCounter;
+    Record.Timestamp = FPlatformTime::Seconds();
+    Record.PreviousState = InPreviousState;
+    Record.NewState = InNewState;
+    Record.TransitionIndex = InTransitionIndex;
+    Record.EvaluatedConditions = EvaluatedConditions;
+
+    if (TransitionHistory)
+        TransitionHistory->Record(Record);
+
+    if (FStateTransitionRecorder::IsRecording())
+        FStateTransitionRecorder::Get().RecordTransition(this, Record);
+}
+#endif
+
 // Adds a new possible state
 void USSM_StateMachine::AddNewStateExisting(uint8 InStateID, USSM_StateBase* InState)
 {
@@ -141,4 +219,78 @@ void USSM_StateMachine::AutoTransitionRegistration(const TArray<FString> StateNa
 
             RegisterTransitionLocal(State1, State2, FName(ConditionFunctionName));
         }
+}
+
+// Whether any of the registered transitions has a condition function owner other than the state machine itself or one of its states
+bool USSM_StateMachine::HasExternalConditionOwners() const
+{
+    for (auto& Transitions: TransitionMap)
+        for (auto& Transition: Transitions.Value)
+        {
+            UObject* Owner = Transition.CondtionFunctionOwner;
+            USSM_StateBase* OwnerState = Cast<USSM_StateBase>(Owner);
+
+            if (Owner != this && !(OwnerState && States.FindKey(OwnerState)))
+                return true;
+        }
+
+    return false;
+}
+
+// Returns the condition function name of the transition with the given index among the transitions of InOriginState
+FName USSM_StateMachine::GetTransitionConditionName(uint8 InOriginState, int32 InTransitionIndex) const
+{
+    const TArray<FStateTransition>* Transitions = TransitionMap.Find(InOriginState);
+
+    if (Transitions && Transitions->IsValidIndex(InTransitionIndex))
+        return (*Transitions)[InTransitionIndex].ConditionFunctionName;
+
+    return NAME_None;
+}
+
+
+// TRANSITION HISTORY
+
+// Starts recording the latest InCapacity transitions into a ring buffer
+void USSM_StateMachine::EnableTransitionHistory(int32 InCapacity)
+{
+#if SSM_WITH_TRANSITION_HISTORY
+    if (InCapacity <= 0)
+    {
+        DisableTransitionHistory();
+        return;
+    }
+
+    TransitionHistory = MakeUnique<FStateTransitionHistory>(InCapacity);
+#endif
+}
+
+// Stops recording transitions and frees the history
+void USSM_StateMachine::DisableTransitionHistory()
+{
+#if SSM_WITH_TRANSITION_HISTORY
+    TransitionHistory.Reset();
+#endif
+}
+
+bool USSM_StateMachine::IsTransitionHistoryEnabled() const
+{
+#if SSM_WITH_TRANSITION_HISTORY
+    return TransitionHistory.IsValid();
+#else
+    return false;
+#endif
+}
+
+// Returns the recorded transitions, from the oldest to the newest
+TArray<FStateTransitionRecord> USSM_StateMachine::GetTransitionHistory() const
+{
+    TArray<FStateTransitionRecord> Records;
+
+#if SSM_WITH_TRANSITION_HISTORY
+    if (TransitionHistory)
+        TransitionHistory->GetRecords(Records);
+#endif
+
+    return Records;
 }
\ No newline at end of file
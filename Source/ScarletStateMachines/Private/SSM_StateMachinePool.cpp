@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SSM_StateMachinePool.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "ScarletStateMachines.h"
+
+// Flags used when moving state machines between the pool and their owners
+static constexpr ERenameFlags PoolRenameFlags = REN_DontCreateRedirectors | REN_DoNotDirty | REN_NonTransactional | REN_ForceNoResetLoaders;
+
+
+// Returns the pool instance
+USSM_StateMachinePool* USSM_StateMachinePool::Get()
+{
+    return GEngine ? GEngine->GetEngineSubsystem<USSM_StateMachinePool>() : nullptr;
+}
+
+void USSM_StateMachinePool::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddUObject(this, &USSM_StateMachinePool::OnWorldCleanup);
+}
+
+void USSM_StateMachinePool::Deinitialize()
+{
+    FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+    ClearPool();
+
+    Super::Deinitialize();
+}
+
+
+// Drops all pooled state machines
+void USSM_StateMachinePool::OnWorldCleanup(UWorld* InWorld, bool InSessionEnded, bool InCleanupResources)
+{
+    ClearPool();
+    Pools.Empty();
+}
+
+// Creates and initializes a new state machine of the given class
+USSM_StateMachine* USSM_StateMachinePool::CreatePooledStateMachine(UClass* InStateMachineClass, UObject* InOwner)
+{
+    USSM_StateMachine* NewStateMachine = NewObject<USSM_StateMachine>(InOwner ? InOwner : this, InStateMachineClass);
+
+    if (NewStateMachine)
+        NewStateMachine->InitStateMachine();
+
+    return NewStateMachine;
+}
+
+
+// Returns an initialized state machine of the given class, reusing a pooled one if possible
+USSM_StateMachine* USSM_StateMachinePool::AcquireStateMachine(TSubclassOf<USSM_StateMachine> InStateMachineClass, UObject* InOwner)
+{
+    if (!InStateMachineClass)
+        return nullptr;
+
+    FStateMachinePoolEntry& Pool = Pools.FindOrAdd(InStateMachineClass);
+
+    while (Pool.FreeStateMachines.Num() > 0)
+    {
+        USSM_StateMachine* StateMachine = Pool.FreeStateMachines.Pop();
+        Pool.Stats.Pooled = Pool.FreeStateMachines.Num();
+
+        if (!IsValid(StateMachine))
+            continue;
+
+        StateMachine->POOL_SetPooled(false);
+
+        if (InOwner && StateMachine->GetOuter() != InOwner)
+            StateMachine->Rename(nullptr, InOwner, PoolRenameFlags);
+
+        Pool.Stats.Hits++;
+        StateMachine->OnAcquiredFromPool(InOwner);
+
+        return StateMachine;
+    }
+
+    Pool.Stats.Misses++;
+
+    USSM_StateMachine* NewStateMachine = CreatePooledStateMachine(InStateMachineClass, InOwner);
+
+    if (NewStateMachine)
+        NewStateMachine->OnAcquiredFromPool(InOwner);
+
+    return NewStateMachine;
+}
+
+// Resets the state machine and returns it to the pool
+void USSM_StateMachinePool::ReleaseStateMachine(USSM_StateMachine* InStateMachine)
+{
+    if (!IsValid(InStateMachine) || InStateMachine->IsPooled())
+        return;
+
+    // Resetting even the state machines, that are not pooled, since the caller will not use them anymore
+    InStateMachine->ResetStateMachine();
+
+    FStateMachinePoolEntry& Pool = Pools.FindOrAdd(InStateMachine->GetClass());
+
+    if (!InStateMachine->IsInitialized())
+    {
+        UE_LOG(LogScarletStateMachines, Warning, TEXT("State machine %s was not initialized and will not be pooled"), *InStateMachine->GetPathName());
+        Pool.Stats.Dropped++;
+        return;
+    }
+
+    if (InStateMachine->HasExternalConditionOwners())
+    {
+        UE_LOG(LogScarletStateMachines, Warning, TEXT("State machine %s has condition functions outside of itself and its states and will not be pooled"), *InStateMachine->GetPathName());
+        Pool.Stats.Dropped++;
+        return;
+    }
+
+    if (Pool.FreeStateMachines.Num() >= MaxPoolSizePerClass)
+    {
+        Pool.Stats.Dropped++;
+        return;
+    }
+
+    Pool.Stats.Releases++;
+    InStateMachine->POOL_SetPooled(true);
+
+    // Detaching from the previous owner, so it can be destroyed independently
+    if (InStateMachine->GetOuter() != this)
+        InStateMachine->Rename(nullptr, this, PoolRenameFlags);
+
+    Pool.FreeStateMachines.Add(InStateMachine);
+    Pool.Stats.Pooled = Pool.FreeStateMachines.Num();
+}
+
+// Creates and initializes state machines of the given class, until the pool contains at least InCount of them
+void USSM_StateMachinePool::WarmUpPool(TSubclassOf<USSM_StateMachine> InStateMachineClass, int32 InCount)
+{
+    if (!InStateMachineClass)
+        return;
+
+    FStateMachinePoolEntry& Pool = Pools.FindOrAdd(InStateMachineClass);
+
+    InCount = FMath::Min(InCount, MaxPoolSizePerClass);
+    Pool.FreeStateMachines.Reserve(InCount);
+
+    while (Pool.FreeStateMachines.Num() < InCount)
+    {
+        USSM_StateMachine* NewStateMachine = CreatePooledStateMachine(InStateMachineClass, this);
+
+        if (!NewStateMachine)
+            break;
+
+        NewStateMachine->POOL_SetPooled(true);
+        Pool.FreeStateMachines.Add(NewStateMachine);
+    }
+
+    Pool.Stats.Pooled = Pool.FreeStateMachines.Num();
+}
+
+// Drops all of the pooled state machines of the given class (all classes if nullptr)
+void USSM_StateMachinePool::ClearPool(TSubclassOf<USSM_StateMachine> InStateMachineClass)
+{
+    for (auto& Pool: Pools)
+    {
+        if (InStateMachineClass && Pool.Key != InStateMachineClass.Get())
+            continue;
+
+        for (USSM_StateMachine* StateMachine: Pool.Value.FreeStateMachines)
+            if (IsValid(StateMachine))
+                StateMachine->POOL_SetPooled(false);
+
+        Pool.Value.FreeStateMachines.Empty();
+        Pool.Value.Stats.Pooled = 0;
+    }
+}
+
+
+// Returns usage statistics of the pool of the given class
+FStateMachinePoolStats USSM_StateMachinePool::GetPoolStats(TSubclassOf<USSM_StateMachine> InStateMachineClass) const
+{
+    if (const FStateMachinePoolEntry* Pool = Pools.Find(InStateMachineClass.Get()))
+        return Pool->Stats;
+
+    return FStateMachinePoolStats();
+}
+
+// Returns usage statistics summed across all classes
+FStateMachinePoolStats USSM_StateMachinePool::GetTotalPoolStats() const
+{
+    FStateMachinePoolStats TotalStats;
+
+    for (auto& Pool: Pools)
+    {
+        TotalStats.Hits += Pool.Value.Stats.Hits;
+        TotalStats.Misses += Pool.Value.Stats.Misses;
+        TotalStats.Releases += Pool.Value.Stats.Releases;
+        TotalStats.Dropped += Pool.Value.Stats.Dropped;
+        TotalStats.Pooled += Pool.Value.Stats.Pooled;
+    }
+
+    return TotalStats;
+}
@@ -0,0 +1,239 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SSM_TransitionHistory.h"
+#include "SSM_StateMachine.h"
+#include "ScarletStateMachines.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/Async.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+#if SSM_WITH_TRANSITION_HISTORY
+
+// Amount of buffered recorder data, after which it is written to the file
+static constexpr int32 RecorderFlushThreshold = 64 * 1024;
+
+static TAutoConsoleVariable<int32> CVarDefaultHistoryCapacity(
+    TEXT("SSM.History.DefaultCapacity"),
+    0,
+    TEXT("Capacity of the transition history, that is enabled on every state machine during initialization (0 - disabled)"));
+
+
+// TRANSITION HISTORY
+
+FStateTransitionHistory::FStateTransitionHistory(int32 InCapacity)
+{
+    Records.SetNum((int32)FMath::RoundUpToPowerOfTwo((uint32)FMath::Clamp(InCapacity, 1, MaxCapacity)));
+    IndexMask = (uint32)Records.Num() - 1;
+}
+
+// Capacity of the history, that is enabled on every state machine during initialization
+int32 FStateTransitionHistory::GetDefaultCapacity()
+{
+    return CVarDefaultHistoryCapacity.GetValueOnGameThread();
+}
+
+// Copies the stored records into OutRecords, from the oldest to the newest
+void FStateTransitionHistory::GetRecords(TArray<FStateTransitionRecord>& OutRecords) const
+{
+    const int32 NumStored = Num();
+    const uint32 FirstRecord = NumRecorded - (uint32)NumStored;
+
+    OutRecords.Reset(NumStored);
+
+    for (int32 i = 0; i < NumStored; i++)
+        OutRecords.Add(Records[(FirstRecord + (uint32)i) & IndexMask]);
+}
+
+
+// TRANSITION RECORDER
+
+bool FStateTransitionRecorder::Recording = false;
+
+FStateTransitionRecorder& FStateTransitionRecorder::Get()
+{
+    static FStateTransitionRecorder Recorder;
+    return Recorder;
+}
+
+// Opens the output file and starts recording
+bool FStateTransitionRecorder::StartRecording(const FString& InFilename)
+{
+    check(IsInGameThread());
+
+    StopRecording();
+
+    FileHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*InFilename));
+
+    if (!FileHandle)
+    {
+        UE_LOG(LogScarletStateMachines, Warning, TEXT("Failed to open transition recording file %s"), *InFilename);
+        return false;
+    }
+
+    Buffer.Reserve(RecorderFlushThreshold);
+    WriteBuffer.Reserve(RecorderFlushThreshold);
+
+    Buffer.Append(reinterpret_cast<const uint8*>("SSMT"), 4);
+    Write(FileVersion);
+
+    Recording = true;
+    return true;
+}
+
+// Writes out all of the buffered data and closes the file
+void FStateTransitionRecorder::StopRecording()
+{
+    check(IsInGameThread());
+
+    if (!FileHandle)
+        return;
+
+    Recording = false;
+
+    Flush();
+    WaitForPendingWrite();
+
+    FileHandle.Reset();
+    Buffer.Empty();
+    WriteBuffer.Empty();
+    KnownStateMachines.Empty();
+    NextStateMachineID = 0;
+}
+
+// Waits for the background write to finish
+void FStateTransitionRecorder::WaitForPendingWrite()
+{
+    if (PendingWrite.IsValid())
+    {
+        PendingWrite.Wait();
+        PendingWrite.Reset();
+    }
+}
+
+// Swaps the buffers and starts writing the full one on a background thread
+void FStateTransitionRecorder::Flush()
+{
+    if (!FileHandle || Buffer.Num() == 0)
+        return;
+
+    // Writes are kept in order, this only blocks if the previous chunk is still being written
+    WaitForPendingWrite();
+
+    Swap(Buffer, WriteBuffer);
+    Buffer.Reset();
+
+    PendingWrite = Async(EAsyncExecution::ThreadPool, [this]()
+    {
+        FileHandle->Write(WriteBuffer.GetData(), WriteBuffer.Num());
+    });
+}
+
+// Appends a transition of the given state machine
+void FStateTransitionRecorder::RecordTransition(const USSM_StateMachine* InStateMachine, const FStateTransitionRecord& InRecord)
+{
+    // Buffer and known machines are shared between all state machines, so recording from worker threads would corrupt them
+    check(IsInGameThread());
+
+    const FObjectKey OuterKey(InStateMachine->GetOuter());
+    FRecordedStateMachine& RecordedStateMachine = KnownStateMachines.FindOrAdd(FObjectKey(InStateMachine), { MAX_uint32, FObjectKey() });
+
+    if (RecordedStateMachine.ID == MAX_uint32 || RecordedStateMachine.Outer != OuterKey)
+    {
+        RecordedStateMachine.ID = NextStateMachineID++;
+        RecordedStateMachine.Outer = OuterKey;
+
+        FTCHARToUTF8 StateMachinePath(*InStateMachine->GetPathName());
+
+        Write((uint8)0);
+        Write(RecordedStateMachine.ID);
+        Write((int32)StateMachinePath.Length());
+        Buffer.Append(reinterpret_cast<const uint8*>(StateMachinePath.Get()), StateMachinePath.Length());
+    }
+
+    Write((uint8)1);
+    Write(RecordedStateMachine.ID);
+    Write(InRecord.FrameNumber);
+    Write(InRecord.Timestamp);
+    Write(InRecord.PreviousState);
+    Write(InRecord.NewState);
+    Write(InRecord.TransitionIndex);
+    Write(InRecord.EvaluatedConditions);
+
+    if (Buffer.Num() >= RecorderFlushThreshold)
+        Flush();
+}
+
+
+// CONSOLE COMMANDS
+
+// Prints the transition history of every state machine, whose name contains the first argument (all if not specified)
+static FAutoConsoleCommand DumpHistoryCommand(
+    TEXT("SSM.History.Dump"),
+    TEXT("Prints transition histories of state machines. Usage: SSM.History.Dump [NameFilter]"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        const FString Filter = Args.Num() > 0 ? Args[0] : FString();
+        TArray<FStateTransitionRecord> Records;
+
+        for (TObjectIterator<USSM_StateMachine> It; It; ++It)
+        {
+            USSM_StateMachine* StateMachine = *It;
+
+            if (StateMachine->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) || !StateMachine->IsTransitionHistoryEnabled() || (!Filter.IsEmpty() && !StateMachine->GetPathName().Contains(Filter)))
+                continue;
+
+            Records = StateMachine->GetTransitionHistory();
+
+            UE_LOG(LogScarletStateMachines, Display, TEXT("%s%s: %d transitions (active state %d)"), *StateMachine->GetPathName(), StateMachine->IsPooled() ? TEXT(" [pooled]") : TEXT(""), Records.Num(), StateMachine->GetActiveState());
+
+            for (const FStateTransitionRecord& Record: Records)
+            {
+                const FString Cause = Record.IsForced() ? FString(TEXT("forced")) :
+                    FString::Printf(TEXT("%s [%d], %d conditions evaluated"), *StateMachine->GetTransitionConditionName(Record.PreviousState, Record.TransitionIndex).ToString(), Record.TransitionIndex, Record.EvaluatedConditions);
+
+                UE_LOG(LogScarletStateMachines, Display, TEXT("    frame %lld  %.4fs  %d -> %d  (%s)"), Record.FrameNumber, Record.Timestamp, Record.PreviousState, Record.NewState, *Cause);
+            }
+        }
+    }));
+
+// Enables (or disables, if capacity is 0) transition history on all of the existing state machines (CDOs, archetypes and pooled state machines are skipped)
+static FAutoConsoleCommand EnableHistoryCommand(
+    TEXT("SSM.History.Enable"),
+    TEXT("Enables transition history on all existing (not pooled) state machines. Usage: SSM.History.Enable [Capacity = 64] (0 - disable)"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        const int32 Capacity = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 64;
+
+        for (TObjectIterator<USSM_StateMachine> It; It; ++It)
+            if (!It->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) && !It->IsPooled())
+                It->EnableTransitionHistory(Capacity);
+    }));
+
+// Starts streaming transitions of all state machines into a binary file
+static FAutoConsoleCommand StartRecordingCommand(
+    TEXT("SSM.Recorder.Start"),
+    TEXT("Starts recording transitions of all state machines into a binary file. Usage: SSM.Recorder.Start [Filename] (relative to the Saved/Profiling directory)"),
+    FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+    {
+        const FString Filename = Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("SSM_Transitions_%s.ssmt"), *FDateTime::Now().ToString());
+        const FString FilePath = FPaths::Combine(FPaths::ProfilingDir(), Filename);
+
+        FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*FPaths::GetPath(FilePath));
+
+        if (FStateTransitionRecorder::Get().StartRecording(FilePath))
+            UE_LOG(LogScarletStateMachines, Display, TEXT("Recording state machine transitions to %s"), *FilePath);
+    }));
+
+// Stops the transition recording
+static FAutoConsoleCommand StopRecordingCommand(
+    TEXT("SSM.Recorder.Stop"),
+    TEXT("Stops recording state machine transitions"),
+    FConsoleCommandDelegate::CreateLambda([]()
+    {
+        FStateTransitionRecorder::Get().StopRecording();
+    }));
+
+#endif // SSM_WITH_TRANSITION_HISTORY
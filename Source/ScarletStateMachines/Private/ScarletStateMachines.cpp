@@ -1,9 +1,12 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "ScarletStateMachines.h"
+#include "SSM_TransitionHistory.h"
 
 #define LOCTEXT_NAMESPACE "FScarletStateMachinesModule"
 
+DEFINE_LOG_CATEGORY(LogScarletStateMachines);
+
 void FScarletStateMachinesModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -13,6 +16,11 @@ void FScarletStateMachinesModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+#if SSM_WITH_TRANSITION_HISTORY
+	// Making sure the buffered transitions reach the file
+	FStateTransitionRecorder::Get().StopRecording();
+#endif
 }
 
 #undef LOCTEXT_NAMESPACE
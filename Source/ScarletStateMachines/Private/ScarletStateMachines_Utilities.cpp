@@ -2,6 +2,7 @@
 
 
 #include "ScarletStateMachines_Utilities.h"
+#include "SSM_StateMachinePool.h"
 
 // Creates a new state machine of a given class
 USSM_StateMachine* UScarletStateMachines_Utilities::CreateStateMachine(TSubclassOf<USSM_StateMachine> StateMachineClass, UObject* Owner, bool AutoInit)
@@ -12,4 +13,27 @@ USSM_StateMachine* UScarletStateMachines_Utilities::CreateStateMachine(TSubclass
         NewStateMachine->InitStateMachine();
 
     return NewStateMachine;
+}
+
+// Returns an initialized state machine of a given class, reusing a pooled one if possible
+USSM_StateMachine* UScarletStateMachines_Utilities::CreateStateMachinePooled(TSubclassOf<USSM_StateMachine> StateMachineClass, UObject* Owner)
+{
+    if (USSM_StateMachinePool* Pool = USSM_StateMachinePool::Get())
+        return Pool->AcquireStateMachine(StateMachineClass, Owner);
+
+    return CreateStateMachine(StateMachineClass, Owner, true);
+}
+
+// Resets the state machine and returns it to the pool
+void UScarletStateMachines_Utilities::ReleaseStateMachine(USSM_StateMachine* StateMachine)
+{
+    if (USSM_StateMachinePool* Pool = USSM_StateMachinePool::Get())
+        Pool->ReleaseStateMachine(StateMachine);
+}
+
+// Creates initialized state machines of a given class ahead of time
+void UScarletStateMachines_Utilities::WarmUpStateMachinePool(TSubclassOf<USSM_StateMachine> StateMachineClass, int32 Count)
+{
+    if (USSM_StateMachinePool* Pool = USSM_StateMachinePool::Get())
+        Pool->WarmUpPool(StateMachineClass, Count);
 }
\ No newline at end of file
@@ -72,6 +72,14 @@ public:
 	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ScarletStateMachines|State")
 	class USSM_StateMachine* GetStateMachine() { return StateMachine; }
 
+	// Called from the state machine, when it is being reset (for example before being returned to the pool)
+	void STATEMACHINE_ResetStateMachine();
+
+	// Must NEVER be called manually. Fires off after the main STATEMACHINE_ResetStateMachine function has be called. Should bring runtime data of the state back to its initial values
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "ScarletStateMachines|State|Background")
+	void STATEMACHINE_OnResetStateMachine();
+	virtual void STATEMACHINE_OnResetStateMachine_Implementation() {}
+
 
 	// Locking
 
@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "UObject/NoExportTypes.h"
 #include "SSM_StateBase.h"
+#include "SSM_TransitionHistory.h"
 #include "SSM_StateMachine.generated.h"
 
 // Transition Condition function delegate
@@ -66,6 +67,15 @@ protected:
 	// Currently active state, what more can I say?
 	uint8 ActiveState = 0;
 
+	// The value of BufferedNewState right after the initialization, restored when the state machine is reset
+	uint8 InitialBufferedState = 0;
+
+	// Whether InitStateMachine has been called
+	bool Initialized = false;
+
+	// Whether the state machine is currently stored in the state machine pool (waiting to be reused)
+	bool Pooled = false;
+
 	/* 
 	 * Map of all registered transitions in the State Machine
 	 * < State -> Array of < TransitionFromThisState > >
@@ -74,6 +84,11 @@ protected:
 	*/
 	TMap<uint8, TArray<FStateTransition>> TransitionMap;
 
+#if SSM_WITH_TRANSITION_HISTORY
+	// Latest transitions of this state machine, nullptr unless enabled with EnableTransitionHistory
+	TUniquePtr<FStateTransitionHistory> TransitionHistory;
+#endif
+
 
 public:
 
@@ -85,8 +100,13 @@ protected:
 
 	// TRANSITIONS
 
-	// Sets a new active state
-	void StateTransition(uint8 InNewState);
+	// Sets a new active state, InTransitionIndex is the index of the fired transition in TransitionMap[ActiveState] (INDEX_NONE if forced)
+	void StateTransition(uint8 InNewState, int32 InTransitionIndex = INDEX_NONE);
+
+#if SSM_WITH_TRANSITION_HISTORY
+	// Writes the transition into the history and the transition recorder (only called when either of them is active)
+	void RecordTransition(uint8 InPreviousState, uint8 InNewState, int32 InTransitionIndex);
+#endif
 
 	// Processes all of the transitions of the given state
 	void UpdateTransitions(uint8 InState) {}
@@ -111,6 +131,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|StateMachine")
 	void UpdateStateMachine(float DeltaTime);
 
+	// Whether InitStateMachine has been called
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ScarletStateMachines|StateMachine")
+	bool IsInitialized() { return Initialized; }
+
 
 	// Called when the state machine is initialized (after the main init) (to be overriden)
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "ScarletStateMachines|StateMachine")
@@ -123,6 +147,40 @@ public:
 	virtual void OnUpdateStateMachine_Implementation(float DeltaTime) {}
 
 
+	/*
+	 * Brings the state machine back to the state it was in right after the initialization, without re-registering states and transitions
+	 * Exits the active state (if any) and clears it, restores the initial state, unlocks all states
+	 * and unbinds OnStateChanged listeners, except the ones bound to the state machine itself or its states
+	 * Is called by the state machine pool when the state machine is released
+	*/
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|StateMachine")
+	void ResetStateMachine();
+
+	// Called when the state machine is reset (after the main reset) (to be overriden)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "ScarletStateMachines|StateMachine")
+	void OnResetStateMachine();
+	virtual void OnResetStateMachine_Implementation() {}
+
+
+	// POOLING
+
+	// Called from the state machine pool
+	void POOL_SetPooled(bool InPooled) { Pooled = InPooled; }
+
+	// Whether the state machine is currently stored in the state machine pool
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ScarletStateMachines|StateMachine")
+	bool IsPooled() { return Pooled; }
+
+	/*
+	 * Called every time the state machine is handed out by the pool, after it was moved to the new owner (to be overriden)
+	 * Initialization only runs once, so any references to the owner (GetOuter) cached there must be updated here
+	 * Anything set here must be cleared in OnResetStateMachine, otherwise pooled state machines keep the previous owner (and its world) alive
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "ScarletStateMachines|StateMachine")
+	void OnAcquiredFromPool(UObject* NewOwner);
+	virtual void OnAcquiredFromPool_Implementation(UObject* NewOwner) {}
+
+
 
 	// STATE MANAGEMENT
 
@@ -169,4 +227,34 @@ public:
 	// Default naming: "Condition_State1_State2"
 	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|StateMachine")
 	void AutoTransitionRegistration(const TArray<FString> StateNames, const FString& ConditionFunctionNamePrefix = "Condition_", const FString& ConditionFunctionNameStateConnector = "_");
+
+
+	// Whether any of the registered transitions has a condition function owner other than the state machine itself or one of its states
+	bool HasExternalConditionOwners() const;
+
+	// Returns the condition function name of the transition with the given index among the transitions of InOriginState (None for forced transitions)
+	FName GetTransitionConditionName(uint8 InOriginState, int32 InTransitionIndex) const;
+
+
+	/*
+	 * TRANSITION HISTORY
+	 * The history is written from the thread, that updates the state machine, and must only be read from that thread
+	 * While the transition recorder is active (SSM.Recorder.Start), all state machines must be updated from the game thread
+	 * Without SSM_WITH_TRANSITION_HISTORY these functions do nothing and the history is always empty
+	*/
+
+	// Starts recording the latest InCapacity transitions into a ring buffer (capacity is rounded up to a power of two)
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|StateMachine|Debug")
+	void EnableTransitionHistory(int32 InCapacity = 64);
+
+	// Stops recording transitions and frees the history
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|StateMachine|Debug")
+	void DisableTransitionHistory();
+
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ScarletStateMachines|StateMachine|Debug")
+	bool IsTransitionHistoryEnabled() const;
+
+	// Returns the recorded transitions, from the oldest to the newest
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|StateMachine|Debug")
+	TArray<FStateTransitionRecord> GetTransitionHistory() const;
 };
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "SSM_StateMachine.h"
+#include "SSM_StateMachinePool.generated.h"
+
+
+// Usage statistics of the pool of a single state machine class
+USTRUCT(BlueprintType)
+struct FStateMachinePoolStats
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Number of acquisitions, that were served by an already pooled state machine
+	UPROPERTY(BlueprintReadOnly)
+	int32 Hits;
+
+	// Number of acquisitions, that had to create and initialize a new state machine
+	UPROPERTY(BlueprintReadOnly)
+	int32 Misses;
+
+	// Number of state machines, that were returned to the pool
+	UPROPERTY(BlueprintReadOnly)
+	int32 Releases;
+
+	// Number of released state machines, that were reset but not pooled (pool was full, state machine was not initialized or had external condition owners)
+	UPROPERTY(BlueprintReadOnly)
+	int32 Dropped;
+
+	// Number of state machines, that are currently waiting in the pool
+	UPROPERTY(BlueprintReadOnly)
+	int32 Pooled;
+
+	FStateMachinePoolStats(): Hits(0), Misses(0), Releases(0), Dropped(0), Pooled(0) {}
+};
+
+// Pooled state machines of a single class
+USTRUCT()
+struct FStateMachinePoolEntry
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Initialized state machines, ready to be reused
+	UPROPERTY()
+	TArray<USSM_StateMachine*> FreeStateMachines;
+
+	// Usage statistics
+	FStateMachinePoolStats Stats;
+};
+
+
+/**
+ * Keeps fully initialized state machines per class, so they can be reused without re-running state and transition registration
+ *
+ * Released state machines are reset with ResetStateMachine and are outered to the pool until they are acquired again
+ * Condition functions of pooled state machines must be located inside the state machine (or its states), since transitions are never re-registered,
+ * state machines with external condition owners, as well as not initialized ones, are refused by the pool
+ * All pooled state machines are dropped whenever a world is cleaned up (level travel, end of PIE), so they never keep an old world alive,
+ * for the same reason OnResetStateMachine must clear anything, that was set in OnAcquiredFromPool
+ * Warmed up state machines (and ones acquired without an owner) are initialized while outered to the pool,
+ * so OnInitStateMachine must not cache GetOuter() as the owner, OnAcquiredFromPool should be used for that instead
+ */
+UCLASS()
+class SCARLETSTATEMACHINES_API USSM_StateMachinePool : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+protected:
+
+	// Pooled state machines < State machine class -> Pool >
+	UPROPERTY()
+	TMap<UClass*, FStateMachinePoolEntry> Pools;
+
+	// Creates and initializes a new state machine of the given class
+	USSM_StateMachine* CreatePooledStateMachine(UClass* InStateMachineClass, UObject* InOwner);
+
+	// Drops all pooled state machines (and per-class entries, so Blueprint classes are not kept alive)
+	void OnWorldCleanup(UWorld* InWorld, bool InSessionEnded, bool InCleanupResources);
+
+	FDelegateHandle WorldCleanupHandle;
+
+public:
+
+	// Maximum amount of state machines stored per class, released state machines above the limit are left to the garbage collector
+	UPROPERTY(BlueprintReadWrite, Category = "ScarletStateMachines|Pool")
+	int32 MaxPoolSizePerClass = 256;
+
+	// Returns the pool instance (nullptr if the engine is not available)
+	static USSM_StateMachinePool* Get();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+
+	// Returns an initialized state machine of the given class, reusing a pooled one if possible
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|Pool")
+	USSM_StateMachine* AcquireStateMachine(TSubclassOf<USSM_StateMachine> InStateMachineClass, UObject* InOwner);
+
+	// Resets the state machine and returns it to the pool, it must NOT be used after this call
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|Pool")
+	void ReleaseStateMachine(USSM_StateMachine* InStateMachine);
+
+	// Creates and initializes state machines of the given class, until the pool contains at least InCount of them (useful during loading)
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|Pool")
+	void WarmUpPool(TSubclassOf<USSM_StateMachine> InStateMachineClass, int32 InCount);
+
+	// Drops all of the pooled state machines of the given class (all classes if nullptr)
+	UFUNCTION(BlueprintCallable, Category = "ScarletStateMachines|Pool")
+	void ClearPool(TSubclassOf<USSM_StateMachine> InStateMachineClass = nullptr);
+
+	// Returns usage statistics of the pool of the given class
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ScarletStateMachines|Pool")
+	FStateMachinePoolStats GetPoolStats(TSubclassOf<USSM_StateMachine> InStateMachineClass) const;
+
+	// Returns usage statistics summed across all classes
+	UFUNCTION(BlueprintCallable, BlueprintPure, Category = "ScarletStateMachines|Pool")
+	FStateMachinePoolStats GetTotalPoolStats() const;
+};
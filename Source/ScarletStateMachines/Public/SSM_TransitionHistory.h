@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "UObject/ObjectKey.h"
+#include "Async/Future.h"
+#include "SSM_TransitionHistory.generated.h"
+
+/*
+ * Set to 0 to compile out the transition history, the transition recorder and their console commands
+ * Only FStateTransitionRecord and the Blueprint API of USSM_StateMachine remain (as no-ops), so code using them still compiles
+ * Compiled out of Shipping builds by default, define it as 1 (for example in the project's Build.cs) to keep it there
+ * When compiled in, both are still disabled by default and cost a single branch per transition
+*/
+#ifndef SSM_WITH_TRANSITION_HISTORY
+	#define SSM_WITH_TRANSITION_HISTORY !UE_BUILD_SHIPPING
+#endif
+
+
+// A single state transition, that happened in a state machine
+USTRUCT(BlueprintType)
+struct FStateTransitionRecord
+{
+	GENERATED_USTRUCT_BODY()
+
+	// Engine frame, on which the transition happened
+	UPROPERTY(BlueprintReadOnly)
+	int64 FrameNumber;
+
+	// Platform time (in seconds), at which the transition happened
+	UPROPERTY(BlueprintReadOnly)
+	double Timestamp;
+
+	// State, that was active before the transition
+	UPROPERTY(BlueprintReadOnly)
+	uint8 PreviousState;
+
+	// State, that became active
+	UPROPERTY(BlueprintReadOnly)
+	uint8 NewState;
+
+	// Index of the fired FStateTransition among the transitions of PreviousState, -1 if the transition was forced (ForceCallStateTransition)
+	UPROPERTY(BlueprintReadOnly)
+	int32 TransitionIndex;
+
+	// Number of condition functions, that were evaluated during the update, that caused the transition
+	UPROPERTY(BlueprintReadOnly)
+	int32 EvaluatedConditions;
+
+	FStateTransitionRecord(): FrameNumber(0), Timestamp(0.0), PreviousState(0), NewState(0), TransitionIndex(INDEX_NONE), EvaluatedConditions(0) {}
+
+	bool IsForced() const { return TransitionIndex == INDEX_NONE; }
+};
+
+
+#if SSM_WITH_TRANSITION_HISTORY
+
+/**
+ * Fixed-size ring buffer of the latest transitions of a single state machine
+ * Memory is allocated once when the history is created, recording a transition never allocates and only overwrites the oldest record
+ * Is written and read from the thread, that updates the state machine
+ */
+class SCARLETSTATEMACHINES_API FStateTransitionHistory
+{
+	// Records storage, size is always a power of two
+	TArray<FStateTransitionRecord> Records;
+
+	// Total number of transitions recorded since the last reset
+	uint32 NumRecorded = 0;
+
+	// Records.Num() - 1, used to wrap around the buffer
+	uint32 IndexMask = 0;
+
+public:
+
+	// Maximum capacity of a single history
+	static constexpr int32 MaxCapacity = 65536;
+
+	// Capacity is clamped to [1, MaxCapacity] and rounded up to a power of two
+	explicit FStateTransitionHistory(int32 InCapacity);
+
+	// Capacity of the history, that is enabled on every state machine during initialization (SSM.History.DefaultCapacity, 0 - disabled)
+	static int32 GetDefaultCapacity();
+
+	// Writes a new record, overwriting the oldest one if the buffer is full
+	FORCEINLINE void Record(const FStateTransitionRecord& InRecord) { Records[NumRecorded++ & IndexMask] = InRecord; }
+
+	// Copies the stored records into OutRecords, from the oldest to the newest
+	void GetRecords(TArray<FStateTransitionRecord>& OutRecords) const;
+
+	// Forgets all of the stored records
+	void Reset() { NumRecorded = 0; }
+
+	int32 GetCapacity() const { return Records.Num(); }
+
+	// Number of currently stored records
+	int32 Num() const { return (int32)FMath::Min<uint32>(NumRecorded, (uint32)Records.Num()); }
+};
+
+
+/**
+ * Streams transitions of all state machines into a compact binary file for offline analysis
+ *
+ * File layout (little endian):
+ * Header:				"SSMT" magic, uint32 version
+ * Machine block (0):	uint8 block type, uint32 machine ID, int32 length + UTF-8 machine path
+ * Transition block (1):	uint8 block type, uint32 machine ID, int64 frame, double timestamp, uint8 previous state, uint8 new state, int32 transition index, int32 evaluated conditions
+ *
+ * Machine IDs are assigned by the recorder and are never reused within a file, a new machine block (with a new ID) is written
+ * before the first transition of every state machine object, and again whenever its outer changes (for example when it is moved by the pool)
+ *
+ * Data is buffered in memory, full buffers are written to the file on a background thread while recording continues into the other one
+ * The recorder is NOT thread safe, state machines must be updated from the game thread while recording
+ */
+class SCARLETSTATEMACHINES_API FStateTransitionRecorder
+{
+	// Whether the recorder is currently active, checked by the state machines on every transition
+	static bool Recording;
+
+	// Output file
+	TUniquePtr<IFileHandle> FileHandle;
+
+	// Data, that has not been written to the file yet
+	TArray<uint8> Buffer;
+
+	// Data, that is currently being written to the file by PendingWrite
+	TArray<uint8> WriteBuffer;
+
+	// Background write of WriteBuffer
+	TFuture<void> PendingWrite;
+
+	// Waits for the background write to finish
+	void WaitForPendingWrite();
+
+	// State machine, that already has its machine block written
+	struct FRecordedStateMachine
+	{
+		// ID used in the file
+		uint32 ID;
+
+		// Outer at the moment the machine block was written
+		FObjectKey Outer;
+	};
+
+	// State machines, that already have their machine block written (FObjectKey includes the serial number, so reused object slots are told apart)
+	TMap<FObjectKey, FRecordedStateMachine> KnownStateMachines;
+
+	// ID, that will be assigned to the next machine block
+	uint32 NextStateMachineID = 0;
+
+	// Swaps the buffers and starts writing the full one on a background thread
+	void Flush();
+
+	template<typename T>
+	void Write(const T& InValue) { Buffer.Append(reinterpret_cast<const uint8*>(&InValue), sizeof(T)); }
+
+public:
+
+	static constexpr uint32 FileVersion = 2;
+
+	static FStateTransitionRecorder& Get();
+
+	FORCEINLINE static bool IsRecording() { return Recording; }
+
+	// Opens the output file and starts recording, returns false if the file could not be opened
+	bool StartRecording(const FString& InFilename);
+
+	// Writes out all of the buffered data and closes the file
+	void StopRecording();
+
+	// Appends a transition of the given state machine
+	void RecordTransition(const class USSM_StateMachine* InStateMachine, const FStateTransitionRecord& InRecord);
+};
+
+#endif // SSM_WITH_TRANSITION_HISTORY
@@ -14,9 +14,23 @@ UCLASS()
 class SCARLETSTATEMACHINES_API UScarletStateMachines_Utilities : public UBlueprintFunctionLibrary
 {
 	GENERATED_BODY()
+
+public:
 	
 	// Creates a new state machine of a given class
 	UFUNCTION(BlueprintCallable, Category="ScarletStateMachines")
 	static USSM_StateMachine* CreateStateMachine(TSubclassOf<USSM_StateMachine> StateMachineClass, UObject* Owner, bool AutoInit = true);
 
+	// Returns an initialized state machine of a given class, reusing a pooled one if possible (must be returned with ReleaseStateMachine)
+	UFUNCTION(BlueprintCallable, Category="ScarletStateMachines")
+	static USSM_StateMachine* CreateStateMachinePooled(TSubclassOf<USSM_StateMachine> StateMachineClass, UObject* Owner);
+
+	// Resets the state machine and returns it to the pool
+	UFUNCTION(BlueprintCallable, Category="ScarletStateMachines")
+	static void ReleaseStateMachine(USSM_StateMachine* StateMachine);
+
+	// Creates initialized state machines of a given class ahead of time, until the pool contains at least Count of them
+	UFUNCTION(BlueprintCallable, Category="ScarletStateMachines")
+	static void WarmUpStateMachinePool(TSubclassOf<USSM_StateMachine> StateMachineClass, int32 Count);
+
 };